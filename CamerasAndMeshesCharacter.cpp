@@ -12,6 +12,8 @@
 #include "DrawDebugHelpers.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "GameFramework/PlayerState.h"
+#include "SoakTestManager.h"
 
 ACamerasAndMeshesCharacter::ACamerasAndMeshesCharacter() {
 	// Set size for collision capsule
@@ -150,27 +152,7 @@ void ACamerasAndMeshesCharacter::ToggleSprintOff() { Sprint = false; }
 void ACamerasAndMeshesCharacter::RightClick() {
 	// if map is open
 	if (MainMapCamera->IsActive()) {
-		FVector WorldLocation, WorldDirection;
-		FVector Start = FVector(MAIN_CAM_LOCATION);
-
-		// deproject cursor location from map view to level location with respect to main map camera
-		UGameplayStatics::GetPlayerController(GetWorld(), 0)->DeprojectMousePositionToWorld(WorldLocation, WorldDirection);
-
-		// length of line trace
-		FVector End = WorldLocation + WorldDirection * 100000;
-
-		// line trace from main map camera to level location of cursor
-		FHitResult Hit;
-		FCollisionQueryParams TraceParams;
-		GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, TraceParams);
-		float X = FMath::Abs(Hit.Location.X - Waypoint->GetActorLocation().X);
-		float Y = FMath::Abs(Hit.Location.Y - Waypoint->GetActorLocation().Y);
-
-		// if there is a waypoint in the general area of cursor, remove it and hide waypoint arrow
-		if (IsValid(Waypoint) && X < 200 && Y < 200) {
-			Waypoint->Destroy();
-			WaypointArrow->SetHiddenInGame(true);
-		}
+		RemoveWaypoint(TraceFromMapCursor().Location);
 	}
 	else {
 		// call blueprint function to play attack animation
@@ -183,40 +165,149 @@ void ACamerasAndMeshesCharacter::RightClick() {
 void ACamerasAndMeshesCharacter::LeftClick() {
 	// if map is open
 	if (MainMapCamera->IsActive()) {
+		PlaceWaypoint(TraceFromMapCursor().Location);
+	}
+	else {
+		// call blueprint function to play attack animation
+		LightAttack();
+	}
+	
+}
+
+FHitResult ACamerasAndMeshesCharacter::TraceFromMapCursor() {
+	FVector WorldLocation, WorldDirection;
+	FVector Start = FVector(MAIN_CAM_LOCATION);
+
+	// deproject cursor location from map view to level location with respect to main map camera
+	UGameplayStatics::GetPlayerController(GetWorld(), 0)->DeprojectMousePositionToWorld(WorldLocation, WorldDirection);
+
+	// length of line trace
+	FVector End = WorldLocation + WorldDirection * 100000;
+
+	// line trace from main map camera to level location of cursor
+	FHitResult Hit;
+	FCollisionQueryParams TraceParams;
+	GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, TraceParams);
+	//DrawDebugLine(GetWorld(), Start, End, FColor::Orange, true, 2.0f);
+	//DrawDebugPoint(GetWorld(), Hit.Location,10, FColor::Orange, true);
+
+	return Hit;
+}
+
+void ACamerasAndMeshesCharacter::PlaceWaypoint(const FVector& Location) {
+	// if waypoint already exists, destroy it
+	if (IsValid(Waypoint)) {
+		Waypoint->Destroy();
+	}
+
+	// spawn waypoint
+	Waypoint = (AWaypoint*) GetWorld()->SpawnActor<AWaypoint>(Location, FRotator(0.0f,0.0f,0.0f));
+
+	// set waypoint arrow as visible
+	WaypointArrow->SetHiddenInGame(false);
 
-		// if waypoint already exists, destroy it
-		if (IsValid(Waypoint)) {
-			Waypoint->Destroy();
+	// in co-op sessions other players on the map see it too
+	if (GetNetMode() != NM_Standalone && IsLocallyControlled()) {
+		FIntPoint Region = FQuantizedWaypointPosition::GetRegion(Location);
+		if (FQuantizedWaypointPosition::IsValidRegion(Region)) {
+			ServerSetSharedWaypoint(Region, FQuantizedWaypointPosition::Quantize(Location));
 		}
+		else {
+			// off the map, don't leave the previous shared marker behind
+			ServerClearSharedWaypoint();
+		}
+	}
+}
 
-		FVector WorldLocation, WorldDirection;
-		FVector Start = FVector(MAIN_CAM_LOCATION);
+void ACamerasAndMeshesCharacter::RemoveWaypoint(const FVector& Location) {
+	// nothing to remove
+	if (!IsValid(Waypoint)) {
+		return;
+	}
 
-		// deproject cursor location from map view to level location with respect to main map camera
-		UGameplayStatics::GetPlayerController(GetWorld(), 0)->DeprojectMousePositionToWorld(WorldLocation, WorldDirection);
+	float X = FMath::Abs(Location.X - Waypoint->GetActorLocation().X);
+	float Y = FMath::Abs(Location.Y - Waypoint->GetActorLocation().Y);
 
-		// length of line trace
-		FVector End = WorldLocation + WorldDirection * 100000;
+	// if there is a waypoint in the general area of location, remove it and hide waypoint arrow
+	if (X < 200 && Y < 200) {
+		Waypoint->Destroy();
+		Waypoint = nullptr;
+		WaypointArrow->SetHiddenInGame(true);
 
-		// line trace from main map camera to level location of cursor
-		FHitResult Hit;
-		FCollisionQueryParams TraceParams;
-		GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, TraceParams);
-		//DrawDebugLine(GetWorld(), Start, End, FColor::Orange, true, 2.0f);
-		//DrawDebugPoint(GetWorld(), Hit.Location,10, FColor::Orange, true);
+		if (GetNetMode() != NM_Standalone && IsLocallyControlled()) {
+			ServerClearSharedWaypoint();
+		}
+	}
+}
 
+bool ACamerasAndMeshesCharacter::ServerSetSharedWaypoint_Validate(FIntPoint InRegion, FQuantizedWaypointPosition Position) {
+	// clients never send regions outside the map
+	return FQuantizedWaypointPosition::IsValidRegion(InRegion);
+}
 
-		// spawn waypoint
-		Waypoint = (AWaypoint*) GetWorld()->SpawnActor<AWaypoint>(Hit.Location, FRotator(0.0f,0.0f,0.0f));
+void ACamerasAndMeshesCharacter::ServerSetSharedWaypoint_Implementation(FIntPoint InRegion, FQuantizedWaypointPosition Position) {
+	// AI controlled characters have no player state and don't share waypoints
+	if (!GetPlayerState()) {
+		return;
+	}
 
-		// set waypoint arrow as visible
-		WaypointArrow->SetHiddenInGame(false);
+	// each player has one waypoint, move the old one
+	ASharedWaypointRegion::SetMarker(GetWorld(), GetPlayerState(), InRegion, Position);
+}
+
+bool ACamerasAndMeshesCharacter::ServerClearSharedWaypoint_Validate() {
+	return true;
+}
+
+void ACamerasAndMeshesCharacter::ServerClearSharedWaypoint_Implementation() {
+	if (GetPlayerState()) {
+		ASharedWaypointRegion::RemoveMarkers(GetWorld(), GetPlayerState());
 	}
-	else {
-		// call blueprint function to play attack animation
-		LightAttack();
+}
+
+void ACamerasAndMeshesCharacter::SharedWaypointNetStats() {
+	ASharedWaypointRegion::LogNetStats(GetWorld());
+}
+
+void ACamerasAndMeshesCharacter::SharedWaypointStress(int32 Count) {
+#if !UE_BUILD_SHIPPING
+	ServerAddTestSharedWaypoints(Count);
+#endif
+}
+
+bool ACamerasAndMeshesCharacter::ServerAddTestSharedWaypoints_Validate(int32 Count) {
+#if !UE_BUILD_SHIPPING
+	return Count >= 0 && Count <= MAX_SHARED_WAYPOINTS_PER_REGION;
+#else
+	return false;
+#endif
+}
+
+void ACamerasAndMeshesCharacter::ServerAddTestSharedWaypoints_Implementation(int32 Count) {
+#if !UE_BUILD_SHIPPING
+	// test markers have no owner, so every player sees them and waypoint clicks don't remove them
+	if (Count == 0) {
+		ASharedWaypointRegion::RemoveMarkers(GetWorld(), nullptr);
+		return;
 	}
-	
+
+	FIntPoint Region = FQuantizedWaypointPosition::GetRegion(GetActorLocation());
+	if (!FQuantizedWaypointPosition::IsValidRegion(Region)) {
+		return;
+	}
+
+	// scatter markers over this character's region at its height, stopping once the region is full
+	for (int32 i = 0; i < Count; i++) {
+		FVector Location;
+		Location.X = WAYPOINT_MAP_MIN_X + (Region.X + FMath::FRand()) * WAYPOINT_REGION_SIZE;
+		Location.Y = WAYPOINT_MAP_MIN_Y + (Region.Y + FMath::FRand()) * WAYPOINT_REGION_SIZE;
+		Location.Z = GetActorLocation().Z;
+
+		if (!ASharedWaypointRegion::AddMarker(GetWorld(), nullptr, Region, FQuantizedWaypointPosition::Quantize(Location))) {
+			break;
+		}
+	}
+#endif
 }
 
 void ACamerasAndMeshesCharacter::ShowHideMap() {
@@ -392,15 +483,34 @@ void ACamerasAndMeshesCharacter::BeginPlay() {
 
 	MyController = Cast<APlayerController>(GetController());
 
+	// soak test bots are AI controlled and have no map or minimap
+	if (!MyController) {
+		return;
+	}
+
 	// widget creation
 	wMainMap = CreateWidget<UMainMapWidget>(GetWorld(), MainMapClass);
 	wMiniMap = CreateWidget<UMiniMapWidget>(GetWorld(), MiniMapClass);
 
 	// add minimap to viewport since we are in 3rd person
 	wMiniMap->AddToViewport();
+
+	// headless soak test run (-SoakTest on the command line)
+	if (FParse::Param(FCommandLine::Get(), TEXT("SoakTest"))) {
+		GetWorld()->SpawnActor<ASoakTestManager>();
+	}
 	
 }
 
+void ACamerasAndMeshesCharacter::UnPossessed() {
+	// player left the session, take their shared waypoints with them (player state is cleared by Super)
+	if (HasAuthority() && GetPlayerState()) {
+		ASharedWaypointRegion::RemoveMarkers(GetWorld(), GetPlayerState());
+	}
+
+	Super::UnPossessed();
+}
+
 void ACamerasAndMeshesCharacter::Tick(float DeltaTime) {
 	Super::Tick(DeltaTime);
 
@@ -4,6 +4,7 @@
 #include "MinimapWidget.h"
 #include "MainMapWidget.h"
 #include "Waypoint.h"
+#include "SharedWaypointRegion.h"
 #include "CamerasAndMeshesCharacter.generated.h"
 
 #define THIRD_PERSON 0
@@ -57,6 +58,9 @@ class ACamerasAndMeshesCharacter : public ACharacter {
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* WaypointArrow;
 
+	// soak test bots drive the same input handlers as a player
+	friend class ASoakTestBotController;
+
 public:
 	ACamerasAndMeshesCharacter();
 
@@ -90,8 +94,23 @@ public:
 	FVector WaypointDirection;
 	FRotator WaypointLookAtDirection;
 
+	UPROPERTY()
 	AWaypoint* Waypoint;
 
+	// spawn this character's waypoint at a level location, replacing any existing one
+	void PlaceWaypoint(const FVector& Location);
+
+	// remove this character's waypoint if it is near a level location
+	void RemoveWaypoint(const FVector& Location);
+
+	// console command, logs per connection bandwidth and the shared waypoints known on this machine
+	UFUNCTION(Exec)
+	void SharedWaypointNetStats();
+
+	// console command, has the server add Count unowned shared waypoints in this character's map region, 0 clears them (not in shipping builds)
+	UFUNCTION(Exec)
+	void SharedWaypointStress(int32 Count);
+
 protected:
 	void ToggleSprintOn();
 	void ToggleSprintOff();
@@ -101,6 +120,19 @@ protected:
 
 	void ShowHideMap();
 
+	// line trace from the main map camera through the mouse cursor to the level
+	FHitResult TraceFromMapCursor();
+
+	// share this character's waypoint with the other players in its map region
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerSetSharedWaypoint(FIntPoint InRegion, FQuantizedWaypointPosition Position);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerClearSharedWaypoint();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerAddTestSharedWaypoints(int32 Count);
+
 	void OnScrollIn();
 	void OnScrollOut();
 
@@ -135,6 +167,8 @@ protected:
 
 	virtual void BeginPlay() override;
 
+	virtual void UnPossessed() override;
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -0,0 +1,275 @@
+#include "SharedWaypointRegion.h"
+#include "EngineUtils.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Materials/MaterialInstance.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/ConstructorHelpers.h"
+
+DEFINE_LOG_CATEGORY(LogSharedWaypoint);
+
+FIntPoint FQuantizedWaypointPosition::GetRegion(const FVector& Location) {
+	return FIntPoint(FMath::FloorToInt((Location.X - WAYPOINT_MAP_MIN_X) / WAYPOINT_REGION_SIZE),
+		FMath::FloorToInt((Location.Y - WAYPOINT_MAP_MIN_Y) / WAYPOINT_REGION_SIZE));
+}
+
+bool FQuantizedWaypointPosition::IsValidRegion(const FIntPoint& InRegion) {
+	return InRegion.X >= 0 && InRegion.X < WAYPOINT_REGION_COUNT && InRegion.Y >= 0 && InRegion.Y < WAYPOINT_REGION_COUNT;
+}
+
+FQuantizedWaypointPosition FQuantizedWaypointPosition::Quantize(const FVector& Location) {
+	FIntPoint InRegion = GetRegion(Location);
+	const int32 XYSteps = 1 << WAYPOINT_XY_BITS;
+	const int32 ZSteps = 1 << WAYPOINT_Z_BITS;
+
+	// offset from the region corner, 0 to 1
+	float OffsetX = (Location.X - WAYPOINT_MAP_MIN_X - InRegion.X * WAYPOINT_REGION_SIZE) / WAYPOINT_REGION_SIZE;
+	float OffsetY = (Location.Y - WAYPOINT_MAP_MIN_Y - InRegion.Y * WAYPOINT_REGION_SIZE) / WAYPOINT_REGION_SIZE;
+
+	FQuantizedWaypointPosition Position;
+	Position.X = (uint16)FMath::Clamp(FMath::RoundToInt(OffsetX * XYSteps), 0, XYSteps - 1);
+	Position.Y = (uint16)FMath::Clamp(FMath::RoundToInt(OffsetY * XYSteps), 0, XYSteps - 1);
+	Position.Z = (uint16)FMath::Clamp(FMath::RoundToInt((Location.Z - WAYPOINT_MAP_MIN_Z) / WAYPOINT_HEIGHT_STEP), 0, ZSteps - 1);
+	return Position;
+}
+
+FVector FQuantizedWaypointPosition::Dequantize(const FIntPoint& InRegion) const {
+	const float XYStep = WAYPOINT_REGION_SIZE / (1 << WAYPOINT_XY_BITS);
+
+	return FVector(WAYPOINT_MAP_MIN_X + InRegion.X * WAYPOINT_REGION_SIZE + X * XYStep,
+		WAYPOINT_MAP_MIN_Y + InRegion.Y * WAYPOINT_REGION_SIZE + Y * XYStep,
+		WAYPOINT_MAP_MIN_Z + Z * WAYPOINT_HEIGHT_STEP);
+}
+
+bool FQuantizedWaypointPosition::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) {
+	uint32 PackedX = X;
+	uint32 PackedY = Y;
+	uint32 PackedZ = Z;
+
+	// SerializeInt writes only the bits needed for values below Max
+	Ar.SerializeInt(PackedX, 1 << WAYPOINT_XY_BITS);
+	Ar.SerializeInt(PackedY, 1 << WAYPOINT_XY_BITS);
+	Ar.SerializeInt(PackedZ, 1 << WAYPOINT_Z_BITS);
+
+	X = (uint16)PackedX;
+	Y = (uint16)PackedY;
+	Z = (uint16)PackedZ;
+
+	bOutSuccess = true;
+	return true;
+}
+
+void FSharedWaypointItem::PostReplicatedAdd(const FSharedWaypointArray& InArraySerializer) {
+	if (InArraySerializer.Region) {
+		InArraySerializer.Region->MarkInstancesDirty();
+	}
+}
+
+void FSharedWaypointItem::PostReplicatedChange(const FSharedWaypointArray& InArraySerializer) {
+	if (InArraySerializer.Region) {
+		InArraySerializer.Region->MarkInstancesDirty();
+	}
+}
+
+void FSharedWaypointItem::PreReplicatedRemove(const FSharedWaypointArray& InArraySerializer) {
+	if (InArraySerializer.Region) {
+		InArraySerializer.Region->MarkInstancesDirty();
+	}
+}
+
+ASharedWaypointRegion::ASharedWaypointRegion() {
+	PrimaryActorTick.bCanEverTick = true;
+
+	bReplicates = true;
+	bAlwaysRelevant = false;
+
+	// markers change on clicks, not every frame
+	NetUpdateFrequency = 5.0f;
+
+	// same mesh and material as the lower part of AWaypoint
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> MarkerMesh(TEXT("/Game/1MyContent/Meshes/WaypointBot.WaypointBot"));
+	static ConstructorHelpers::FObjectFinder<UMaterialInstance> MarkerMaterial(TEXT("/Game/1MyContent/Materials/WaypointBotMaterialInstance.WaypointBotMaterialInstance"));
+	MarkerInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Marker Instances"));
+	MarkerInstances->SetStaticMesh(MarkerMesh.Object);
+	MarkerInstances->SetMaterial(0, MarkerMaterial.Object);
+	MarkerInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MarkerInstances->SetCastShadow(false);
+	RootComponent = MarkerInstances;
+}
+
+void ASharedWaypointRegion::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+
+	Markers.Region = this;
+}
+
+void ASharedWaypointRegion::BeginPlay() {
+	Super::BeginPlay();
+
+	// nothing to draw on a dedicated server
+	SetActorTickEnabled(GetNetMode() != NM_DedicatedServer);
+}
+
+void ASharedWaypointRegion::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ASharedWaypointRegion, Region, COND_InitialOnly);
+	DOREPLIFETIME(ASharedWaypointRegion, Markers);
+}
+
+bool ASharedWaypointRegion::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const {
+	// use the viewer's pawn rather than the camera so opening the main map doesn't change region
+	const AActor* Viewer = ViewTarget ? ViewTarget : RealViewer;
+	FVector ViewerLocation = Viewer ? Viewer->GetActorLocation() : SrcLocation;
+
+	return FQuantizedWaypointPosition::GetRegion(ViewerLocation) == Region;
+}
+
+bool ASharedWaypointRegion::IsLocalPlayerInRegion() const {
+	APlayerController* LocalController = GetWorld()->GetFirstPlayerController();
+	if (!LocalController || !LocalController->GetPawn()) {
+		return false;
+	}
+
+	return FQuantizedWaypointPosition::GetRegion(LocalController->GetPawn()->GetActorLocation()) == Region;
+}
+
+void ASharedWaypointRegion::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	// clients only have this actor while it is relevant, a listen server host has every region
+	if (GetNetMode() == NM_ListenServer) {
+		bool bVisible = IsLocalPlayerInRegion();
+		if (MarkerInstances->IsVisible() != bVisible) {
+			MarkerInstances->SetVisibility(bVisible);
+		}
+	}
+
+	if (bInstancesDirty) {
+		RebuildInstances();
+	}
+}
+
+void ASharedWaypointRegion::RebuildInstances() {
+	bInstancesDirty = false;
+	MarkerInstances->ClearInstances();
+
+	APlayerController* LocalController = GetWorld()->GetFirstPlayerController();
+	APlayerState* LocalPlayerState = LocalController ? LocalController->PlayerState : nullptr;
+
+	for (const FSharedWaypointItem& Item : Markers.Items) {
+		// the local player's own waypoint is already spawned by their character
+		if (Item.Owner && Item.Owner == LocalPlayerState) {
+			continue;
+		}
+
+		// matches the lower mesh placement in AWaypoint
+		FVector Location = Item.Position.Dequantize(Region) + FVector(0.0f, 0.0f, 150.0f);
+		MarkerInstances->AddInstance(FTransform(FRotator(0.0f, 0.0f, 0.0f), Location, FVector(0.5f, 0.5f, 0.5f)));
+	}
+}
+
+bool ASharedWaypointRegion::AddMarker(UWorld* World, APlayerState* InOwner, const FIntPoint& InRegion, const FQuantizedWaypointPosition& Position) {
+	if (!FQuantizedWaypointPosition::IsValidRegion(InRegion)) {
+		return false;
+	}
+
+	// find the actor for this region, or create it on first use
+	ASharedWaypointRegion* RegionActor = nullptr;
+	for (TActorIterator<ASharedWaypointRegion> It(World); It; ++It) {
+		if (It->Region == InRegion) {
+			RegionActor = *It;
+			break;
+		}
+	}
+	if (!RegionActor) {
+		RegionActor = World->SpawnActor<ASharedWaypointRegion>();
+		RegionActor->Region = InRegion;
+	}
+
+	if (RegionActor->Markers.Items.Num() >= MAX_SHARED_WAYPOINTS_PER_REGION) {
+		return false;
+	}
+
+	FSharedWaypointItem& Item = RegionActor->Markers.Items.AddDefaulted_GetRef();
+	Item.Position = Position;
+	Item.Owner = InOwner;
+	RegionActor->Markers.MarkItemDirty(Item);
+
+	// a listen server host gets no replication callbacks
+	RegionActor->MarkInstancesDirty();
+	return true;
+}
+
+bool ASharedWaypointRegion::SetMarker(UWorld* World, APlayerState* InOwner, const FIntPoint& InRegion, const FQuantizedWaypointPosition& Position) {
+	if (!FQuantizedWaypointPosition::IsValidRegion(InRegion)) {
+		return false;
+	}
+
+	// a move inside the same region replicates as a change to the existing item
+	for (TActorIterator<ASharedWaypointRegion> It(World); It; ++It) {
+		if (It->Region != InRegion) {
+			continue;
+		}
+
+		for (FSharedWaypointItem& Item : It->Markers.Items) {
+			if (Item.Owner == InOwner) {
+				Item.Position = Position;
+				It->Markers.MarkItemDirty(Item);
+				It->MarkInstancesDirty();
+				return true;
+			}
+		}
+	}
+
+	// first marker, or it moved to another region
+	RemoveMarkers(World, InOwner);
+	return AddMarker(World, InOwner, InRegion, Position);
+}
+
+void ASharedWaypointRegion::RemoveMarkers(UWorld* World, APlayerState* InOwner) {
+	for (TActorIterator<ASharedWaypointRegion> It(World); It; ++It) {
+		TArray<FSharedWaypointItem>& Items = It->Markers.Items;
+		bool bRemoved = false;
+
+		for (int32 i = Items.Num() - 1; i >= 0; i--) {
+			if (Items[i].Owner == InOwner) {
+				Items.RemoveAtSwap(i);
+				bRemoved = true;
+			}
+		}
+
+		// empty regions are kept, there are at most WAYPOINT_REGION_COUNT^2 of them
+		if (bRemoved) {
+			It->Markers.MarkArrayDirty();
+			It->MarkInstancesDirty();
+		}
+	}
+}
+
+void ASharedWaypointRegion::LogNetStats(UWorld* World) {
+	UNetDriver* NetDriver = World->GetNetDriver();
+	if (!NetDriver) {
+		UE_LOG(LogSharedWaypoint, Display, TEXT("Not networked, shared waypoints are only replicated in listen server or client sessions"));
+		return;
+	}
+
+	// a client has its server connection, a server has one connection per client
+	TArray<UNetConnection*> Connections = NetDriver->ClientConnections;
+	if (NetDriver->ServerConnection) {
+		Connections.Add(NetDriver->ServerConnection);
+	}
+
+	for (UNetConnection* Connection : Connections) {
+		UE_LOG(LogSharedWaypoint, Display, TEXT("Connection %s: in %d B/s, out %d B/s"),
+			*Connection->LowLevelGetRemoteAddress(true), Connection->InBytesPerSecond, Connection->OutBytesPerSecond);
+	}
+
+	// clients only have the regions relevant to them
+	for (TActorIterator<ASharedWaypointRegion> It(World); It; ++It) {
+		UE_LOG(LogSharedWaypoint, Display, TEXT("Region (%d, %d): %d markers"), It->Region.X, It->Region.Y, It->Markers.Items.Num());
+	}
+}
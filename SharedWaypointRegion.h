@@ -0,0 +1,144 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "SharedWaypointRegion.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSharedWaypoint, Log, All);
+
+// playable map area, the square seen by the main map camera at MAIN_CAM_LOCATION (30000 uu up, 90 degree FOV)
+#define WAYPOINT_MAP_MIN_X -24000.0f
+#define WAYPOINT_MAP_MIN_Y -20000.0f
+#define WAYPOINT_MAP_MIN_Z -8192.0f
+
+// the map is split into WAYPOINT_REGION_COUNT x WAYPOINT_REGION_COUNT regions, each replicated by its own actor
+#define WAYPOINT_REGION_COUNT 4
+#define WAYPOINT_REGION_SIZE 15000.0f
+
+// position bits inside a region, 15000 / 4096 = ~3.7 uu steps horizontally
+#define WAYPOINT_XY_BITS 12
+#define WAYPOINT_Z_BITS 10
+#define WAYPOINT_HEIGHT_STEP 16.0f
+
+// a client entering a region receives all of its markers in one update, which must stay
+// under net.MaxNumberOfAllowedTArrayChangesPerUpdate (2048 by default)
+#define MAX_SHARED_WAYPOINTS_PER_REGION 2000
+
+class APlayerState;
+class ASharedWaypointRegion;
+class UInstancedStaticMeshComponent;
+
+// marker position relative to its map region, 34 bits on the wire
+USTRUCT()
+struct FQuantizedWaypointPosition {
+	GENERATED_BODY()
+
+	// WAYPOINT_XY_BITS steps across the region
+	uint16 X = 0;
+	uint16 Y = 0;
+
+	// WAYPOINT_HEIGHT_STEP steps above WAYPOINT_MAP_MIN_Z
+	uint16 Z = 0;
+
+	static FIntPoint GetRegion(const FVector& Location);
+	static bool IsValidRegion(const FIntPoint& InRegion);
+	static FQuantizedWaypointPosition Quantize(const FVector& Location);
+	FVector Dequantize(const FIntPoint& InRegion) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FQuantizedWaypointPosition> : public TStructOpsTypeTraitsBase2<FQuantizedWaypointPosition> {
+	enum { WithNetSerializer = true };
+};
+
+USTRUCT()
+struct FSharedWaypointItem : public FFastArraySerializerItem {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FQuantizedWaypointPosition Position;
+
+	// player that placed the marker, null for stress test markers
+	UPROPERTY()
+	APlayerState* Owner = nullptr;
+
+	// client side replication callbacks, keep the marker instances in sync
+	void PostReplicatedAdd(const struct FSharedWaypointArray& InArraySerializer);
+	void PostReplicatedChange(const struct FSharedWaypointArray& InArraySerializer);
+	void PreReplicatedRemove(const struct FSharedWaypointArray& InArraySerializer);
+};
+
+// delta replicated, only added, changed and removed markers are sent
+USTRUCT()
+struct FSharedWaypointArray : public FFastArraySerializer {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FSharedWaypointItem> Items;
+
+	// region actor holding this array
+	ASharedWaypointRegion* Region = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms) {
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSharedWaypointItem, FSharedWaypointArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSharedWaypointArray> : public TStructOpsTypeTraitsBase2<FSharedWaypointArray> {
+	enum { WithNetDeltaSerializer = true };
+};
+
+// holds the shared markers of one map region, only relevant to players standing in that region
+UCLASS()
+class CAMERASANDMESHES_API ASharedWaypointRegion : public AActor {
+	GENERATED_BODY()
+
+	// one instance per shared marker, the local player's own waypoint is a full AWaypoint
+	UPROPERTY(VisibleAnywhere, Category = Waypoint)
+	UInstancedStaticMeshComponent* MarkerInstances;
+
+public:
+	ASharedWaypointRegion();
+
+	UPROPERTY(Replicated)
+	FIntPoint Region;
+
+	UPROPERTY(Replicated)
+	FSharedWaypointArray Markers;
+
+	// server only, adds a marker to its region actor and spawns the actor if needed, false if the region is full
+	static bool AddMarker(UWorld* World, APlayerState* InOwner, const FIntPoint& InRegion, const FQuantizedWaypointPosition& Position);
+
+	// server only, moves a player's single marker, updating it in place when it stays in the same region
+	static bool SetMarker(UWorld* World, APlayerState* InOwner, const FIntPoint& InRegion, const FQuantizedWaypointPosition& Position);
+
+	// server only, removes every marker owned by InOwner (null removes stress test markers)
+	static void RemoveMarkers(UWorld* World, APlayerState* InOwner);
+
+	// logs bandwidth of each net connection and the markers this machine knows about
+	static void LogNetStats(UWorld* World);
+
+	// rebuild marker instances on the next tick
+	void MarkInstancesDirty() { bInstancesDirty = true; }
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	virtual void PostInitializeComponents() override;
+
+protected:
+	virtual void BeginPlay() override;
+
+	// true if the local player's pawn is in this region, the same rule IsNetRelevantFor applies to clients
+	bool IsLocalPlayerInRegion() const;
+
+	void RebuildInstances();
+
+	bool bInstancesDirty = false;
+};
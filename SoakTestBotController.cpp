@@ -0,0 +1,86 @@
+#include "SoakTestBotController.h"
+#include "CamerasAndMeshesCharacter.h"
+
+ASoakTestBotController::ASoakTestBotController() {
+	PrimaryActorTick.bCanEverTick = true;
+
+	// keep the heading picked in DoRandomAction instead of following the pawn's rotation
+	bSetControlRotationFromPawnOrientation = false;
+}
+
+void ASoakTestBotController::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	ACamerasAndMeshesCharacter* Bot = Cast<ACamerasAndMeshesCharacter>(GetPawn());
+	if (!Bot) {
+		return;
+	}
+
+	// axis bindings are called every frame, so are the bot's
+	Bot->MoveForward(ForwardInput);
+	Bot->MoveRight(RightInput);
+
+	// pick a new action once the current one has run its course
+	NextActionDelay -= DeltaTime;
+	if (NextActionDelay <= 0.0f) {
+		DoRandomAction(Bot);
+		NextActionDelay = Stream.FRandRange(BOT_MIN_ACTION_DELAY, BOT_MAX_ACTION_DELAY);
+	}
+}
+
+void ASoakTestBotController::DoRandomAction(ACamerasAndMeshesCharacter* Bot) {
+	switch (Stream.RandRange(0, 5)) {
+	case 0:
+		// change direction and heading
+		ForwardInput = Stream.FRandRange(-1.0f, 1.0f);
+		RightInput = Stream.FRandRange(-1.0f, 1.0f);
+		SetControlRotation(FRotator(0.0f, Stream.FRandRange(0.0f, 360.0f), 0.0f));
+		break;
+
+	case 1:
+		// sprint key pressed or released
+		if (Bot->Sprint) {
+			Bot->ToggleSprintOff();
+		}
+		else {
+			Bot->ToggleSprintOn();
+		}
+		break;
+
+	case 2:
+		// main map is never open for bots so clicks are attacks
+		Bot->LeftClick();
+		break;
+
+	case 3:
+		Bot->RightClick();
+		break;
+
+	case 4: {
+		// line trace straight down from main map camera height onto a nearby spot, like a map click
+		FVector Target = Bot->GetActorLocation();
+		Target.X += Stream.FRandRange(-BOT_WAYPOINT_RANGE, BOT_WAYPOINT_RANGE);
+		Target.Y += Stream.FRandRange(-BOT_WAYPOINT_RANGE, BOT_WAYPOINT_RANGE);
+
+		FVector Start = FVector(Target.X, Target.Y, FVector(MAIN_CAM_LOCATION).Z);
+		FVector End = FVector(Target.X, Target.Y, -100000.0f);
+
+		FHitResult Hit;
+		FCollisionQueryParams TraceParams;
+		if (GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, TraceParams)) {
+			Bot->PlaceWaypoint(Hit.Location);
+		}
+		break;
+	}
+
+	case 5:
+		// delete the waypoint if there is one, otherwise exercise the miss path
+		if (IsValid(Bot->Waypoint)) {
+			Bot->RemoveWaypoint(Bot->Waypoint->GetActorLocation());
+		}
+		else {
+			Bot->RemoveWaypoint(Bot->GetActorLocation());
+		}
+		break;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "SoakTestBotController.generated.h"
+
+#define BOT_WAYPOINT_RANGE 5000.0f
+#define BOT_MIN_ACTION_DELAY 0.5f
+#define BOT_MAX_ACTION_DELAY 3.0f
+
+class ACamerasAndMeshesCharacter;
+
+// drives a soak test character through the same input handlers a player uses
+UCLASS()
+class CAMERASANDMESHES_API ASoakTestBotController : public AAIController {
+	GENERATED_BODY()
+
+public:
+	ASoakTestBotController();
+
+	// seeded by the soak test manager so runs are reproducible
+	FRandomStream Stream;
+
+	// axis values fed to MoveForward / MoveRight every frame, like held keys
+	float ForwardInput = 0.0f;
+	float RightInput = 0.0f;
+
+	float NextActionDelay = 0.0f;
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	void DoRandomAction(ACamerasAndMeshesCharacter* Bot);
+};
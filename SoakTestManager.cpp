@@ -0,0 +1,193 @@
+#include "SoakTestManager.h"
+#include "CamerasAndMeshesCharacter.h"
+#include "SoakTestBotController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+DEFINE_LOG_CATEGORY(LogSoakTest);
+
+ASoakTestManager::ASoakTestManager() {
+	PrimaryActorTick.bCanEverTick = true;
+
+	NumBots = 16;
+	DurationHours = 4.0f;
+	SampleSeconds = 60.0f;
+	WarmupSeconds = 300.0f;
+	Seed = 0;
+
+	MaxMemoryGrowthMB = 256.0f;
+	MaxObjectGrowth = 20000;
+	MaxGCPauseMs = 100.0f;
+	MaxAvgFrameMs = 100.0f;
+}
+
+void ASoakTestManager::BeginPlay() {
+	Super::BeginPlay();
+
+	// command line overrides
+	const TCHAR* CommandLine = FCommandLine::Get();
+	FParse::Value(CommandLine, TEXT("SoakBots="), NumBots);
+	FParse::Value(CommandLine, TEXT("SoakHours="), DurationHours);
+	FParse::Value(CommandLine, TEXT("SoakSampleSeconds="), SampleSeconds);
+	FParse::Value(CommandLine, TEXT("SoakWarmupSeconds="), WarmupSeconds);
+	FParse::Value(CommandLine, TEXT("SoakSeed="), Seed);
+	FParse::Value(CommandLine, TEXT("SoakMaxMemoryGrowthMB="), MaxMemoryGrowthMB);
+	FParse::Value(CommandLine, TEXT("SoakMaxObjectGrowth="), MaxObjectGrowth);
+	FParse::Value(CommandLine, TEXT("SoakMaxGCPauseMs="), MaxGCPauseMs);
+	FParse::Value(CommandLine, TEXT("SoakMaxAvgFrameMs="), MaxAvgFrameMs);
+
+	if (!FParse::Value(CommandLine, TEXT("SoakCsv="), CsvPath)) {
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("SoakTest") / FString::Printf(TEXT("Soak-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	FFileHelper::SaveStringToFile(TEXT("ElapsedSeconds,AvgFrameMs,MaxFrameMs,GCCount,MaxGCPauseMs,TotalGCPauseMs,LiveObjects,ResidentMB,ObjectGrowth,MemoryGrowthMB\n"), *CsvPath);
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &ASoakTestManager::OnPreGarbageCollect);
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ASoakTestManager::OnPostGarbageCollect);
+
+	SpawnBots();
+	if (bFinished) {
+		return;
+	}
+
+	StartTime = FPlatformTime::Seconds();
+	NextSampleTime = StartTime + SampleSeconds;
+
+	UE_LOG(LogSoakTest, Display, TEXT("Soak test started: %d bots for %.2f hours, writing %s"), NumBots, DurationHours, *CsvPath);
+}
+
+void ASoakTestManager::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().RemoveAll(this);
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASoakTestManager::SpawnBots() {
+	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(GetWorld(), 0);
+	if (!Player) {
+		Finish(false, TEXT("no player character to copy bots from"));
+		return;
+	}
+
+	// use the player's class so bots get the blueprint mesh, animations and attacks
+	TSubclassOf<ACamerasAndMeshesCharacter> BotClass = Player->GetClass();
+
+	for (int32 i = 0; i < NumBots; i++) {
+		// spread bots in a ring around the player
+		FVector Offset = FRotator(0.0f, 360.0f * i / NumBots, 0.0f).Vector() * BOT_SPAWN_RADIUS;
+		FTransform SpawnTransform(Player->GetActorLocation() + Offset);
+
+		ACamerasAndMeshesCharacter* Bot = GetWorld()->SpawnActorDeferred<ACamerasAndMeshesCharacter>(BotClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (!Bot) {
+			continue;
+		}
+		Bot->AIControllerClass = ASoakTestBotController::StaticClass();
+		Bot->AutoPossessAI = EAutoPossessAI::Spawned;
+		Bot->FinishSpawning(SpawnTransform);
+
+		if (ASoakTestBotController* BotController = Cast<ASoakTestBotController>(Bot->GetController())) {
+			BotController->Stream.Initialize(Seed + i);
+		}
+	}
+}
+
+void ASoakTestManager::OnPreGarbageCollect() {
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void ASoakTestManager::OnPostGarbageCollect() {
+	double Pause = FPlatformTime::Seconds() - GCStartTime;
+	GCPauseTotal += Pause;
+	GCPauseMax = FMath::Max(GCPauseMax, (float)(Pause * 1000.0));
+	GCCount++;
+}
+
+void ASoakTestManager::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (bFinished) {
+		return;
+	}
+
+	// real frame time, not dilated game time
+	float FrameMs = FApp::GetDeltaTime() * 1000.0f;
+	FrameTimeTotal += FrameMs;
+	FrameTimeMax = FMath::Max(FrameTimeMax, FrameMs);
+	FrameCount++;
+
+	double Now = FPlatformTime::Seconds();
+	if (Now >= NextSampleTime) {
+		NextSampleTime += SampleSeconds;
+		TakeSample(Now - StartTime);
+	}
+
+	if (!bFinished && Now - StartTime >= DurationHours * 3600.0) {
+		Finish(true, TEXT("duration reached"));
+	}
+}
+
+void ASoakTestManager::TakeSample(double Elapsed) {
+	float AvgFrameMs = FrameCount > 0 ? FrameTimeTotal / FrameCount : 0.0f;
+	int32 LiveObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	uint64 ResidentMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+	// first sample after warmup is the baseline for growth
+	if (!bHasBaseline && Elapsed >= WarmupSeconds) {
+		bHasBaseline = true;
+		BaselineMemory = ResidentMemory;
+		BaselineObjects = LiveObjects;
+	}
+
+	int32 ObjectGrowth = bHasBaseline ? LiveObjects - BaselineObjects : 0;
+	float MemoryGrowthMB = bHasBaseline ? ((double)ResidentMemory - (double)BaselineMemory) / (1024.0 * 1024.0) : 0.0f;
+
+	FString Row = FString::Printf(TEXT("%.0f,%.2f,%.2f,%d,%.2f,%.2f,%d,%.1f,%d,%.1f\n"),
+		Elapsed, AvgFrameMs, FrameTimeMax, GCCount, GCPauseMax, GCPauseTotal * 1000.0,
+		LiveObjects, ResidentMemory / (1024.0 * 1024.0), ObjectGrowth, MemoryGrowthMB);
+	FFileHelper::SaveStringToFile(Row, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	float IntervalGCPauseMax = GCPauseMax;
+
+	// reset per interval counters
+	FrameTimeTotal = 0.0;
+	FrameTimeMax = 0.0f;
+	FrameCount = 0;
+	GCPauseTotal = 0.0;
+	GCPauseMax = 0.0f;
+	GCCount = 0;
+
+	// hitches during warmup (level streaming, shader compiles) are not counted
+	if (!bHasBaseline) {
+		return;
+	}
+
+	if (MemoryGrowthMB > MaxMemoryGrowthMB) {
+		Finish(false, FString::Printf(TEXT("resident memory grew %.1f MB (limit %.1f MB)"), MemoryGrowthMB, MaxMemoryGrowthMB));
+	}
+	else if (ObjectGrowth > MaxObjectGrowth) {
+		Finish(false, FString::Printf(TEXT("live UObjects grew by %d (limit %d)"), ObjectGrowth, MaxObjectGrowth));
+	}
+	else if (IntervalGCPauseMax > MaxGCPauseMs) {
+		Finish(false, FString::Printf(TEXT("GC pause of %.2f ms (limit %.2f ms)"), IntervalGCPauseMax, MaxGCPauseMs));
+	}
+	else if (AvgFrameMs > MaxAvgFrameMs) {
+		Finish(false, FString::Printf(TEXT("average frame time %.2f ms (limit %.2f ms)"), AvgFrameMs, MaxAvgFrameMs));
+	}
+}
+
+void ASoakTestManager::Finish(bool bPassed, const FString& Reason) {
+	bFinished = true;
+
+	if (bPassed) {
+		UE_LOG(LogSoakTest, Display, TEXT("Soak test passed: %s"), *Reason);
+	}
+	else {
+		UE_LOG(LogSoakTest, Error, TEXT("Soak test failed: %s"), *Reason);
+	}
+
+	FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SoakTestManager.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSoakTest, Log, All);
+
+#define BOT_SPAWN_RADIUS 500.0f
+
+/**
+ * Headless soak test, spawned by the player character when run with -SoakTest.
+ * Spawns AI controlled copies of the player character, samples frame time, GC pauses,
+ * live UObjects and resident memory into a CSV and exits non-zero if growth exceeds the limits.
+ *
+ * Command line options (defaults in the constructor):
+ *   -SoakBots=  -SoakHours=  -SoakSampleSeconds=  -SoakWarmupSeconds=  -SoakSeed=  -SoakCsv=
+ *   -SoakMaxMemoryGrowthMB=  -SoakMaxObjectGrowth=  -SoakMaxGCPauseMs=  -SoakMaxAvgFrameMs=
+ */
+UCLASS()
+class CAMERASANDMESHES_API ASoakTestManager : public AActor {
+	GENERATED_BODY()
+
+public:
+	ASoakTestManager();
+
+	int32 NumBots;
+	float DurationHours;
+	float SampleSeconds;
+	float WarmupSeconds;
+	int32 Seed;
+	FString CsvPath;
+
+	// failure thresholds, growth is measured against the first sample after warmup
+	float MaxMemoryGrowthMB;
+	int32 MaxObjectGrowth;
+	float MaxGCPauseMs;
+	float MaxAvgFrameMs;
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void SpawnBots();
+
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	// write one CSV row and check it against the thresholds
+	void TakeSample(double Elapsed);
+
+	void Finish(bool bPassed, const FString& Reason);
+
+	double StartTime = 0.0;
+	double NextSampleTime = 0.0;
+	bool bFinished = false;
+
+	// frame time since the last sample
+	double FrameTimeTotal = 0.0;
+	float FrameTimeMax = 0.0f;
+	int32 FrameCount = 0;
+
+	// garbage collections since the last sample
+	double GCStartTime = 0.0;
+	double GCPauseTotal = 0.0;
+	float GCPauseMax = 0.0f;
+	int32 GCCount = 0;
+
+	bool bHasBaseline = false;
+	uint64 BaselineMemory = 0;
+	int32 BaselineObjects = 0;
+};